@@ -21,6 +21,12 @@
 #include <mutex>
 #include <atomic>
 #include <ctime>
+#include <exception>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <algorithm>
 
 #if __cplusplus < 201103L
 	#error "Your compiler must support c++11 features."
@@ -71,12 +77,14 @@ struct DefStr {
 	static constexpr Descriptor empty = {"", L""};
 	static constexpr Descriptor space = {" ", L" "};
 	static constexpr Descriptor colon = {":", L":"};
+	static constexpr Descriptor equal = {"=", L"="};
 	static constexpr Descriptor under = {"_", L"_"};
 	static constexpr Descriptor zero = {"0", L"0"};
 	static constexpr Descriptor openSqBracket = {"[", L"["};
 	static constexpr Descriptor closeSqBracket = {"]", L"]"};
 	static constexpr Descriptor lrArrow = {"=>", L"=>"};
 	static constexpr Descriptor rlArrow = {"<=", L"<="};
+	static constexpr Descriptor flightRecorder = {"flight recorder", L"flight recorder"};
 
 	//Definitions of compound string constants.
 	static constexpr Descriptor levels = {
@@ -120,6 +128,119 @@ std::basic_string<TChar> strMonth(const int n)
 	return result;
 }
 
+// Converts log strings to UTF-8 byte strings and back.
+// It's common version therefore it's empty.
+// Below you can find the specialization for each supported characher data type.
+template <typename TChar>
+struct Utf8 {};
+
+//Specialization for char data type (char strings are supposed to be UTF-8 already)
+template <>
+struct Utf8<char> {
+	static std::string encode(const std::string& s) {return s;}
+	static std::string decode(const std::string& s) {return s;}
+};
+
+//Specialization for wchar_t data type.
+// wchar_t strings are supposed to be UTF-32 or UTF-16 (depending on size of wchar_t).
+// Each invalid code point or byte sequence is replaced by U+FFFD.
+template <>
+struct Utf8<wchar_t> {
+	static std::string encode(const std::wstring& s)
+	{
+		std::string result;
+		result.reserve(s.size());
+		for (size_t i = 0; i < s.size(); ++i) {
+			char32_t cp = static_cast<char32_t>(s[i]);
+			if (sizeof(wchar_t) == 2) {
+				cp &= 0xFFFF;
+				if (isHighSurrogate(cp) && i + 1 < s.size() && isLowSurrogate(s[i + 1] & 0xFFFF)) {
+					cp = 0x10000 + ((cp - 0xD800) << 10) + ((s[i + 1] & 0xFFFF) - 0xDC00);
+					++i;
+				}
+			}
+			appendUtf8(result, isValid(cp) ? cp : REPLACEMENT);
+		}
+		return result;
+	}
+
+	static std::wstring decode(const std::string& s)
+	{
+		std::wstring result;
+		result.reserve(s.size());
+		size_t i = 0;
+		while (i < s.size()) {
+			const unsigned char lead = s[i];
+			int len = 0;
+			char32_t cp = 0;
+			char32_t min = 0;
+			if (lead < 0x80) {
+				len = 1; cp = lead;
+			} else if ((lead & 0xE0) == 0xC0) {
+				len = 2; cp = lead & 0x1F; min = 0x80;
+			} else if ((lead & 0xF0) == 0xE0) {
+				len = 3; cp = lead & 0x0F; min = 0x800;
+			} else if ((lead & 0xF8) == 0xF0) {
+				len = 4; cp = lead & 0x07; min = 0x10000;
+			} else {
+				appendWide(result, REPLACEMENT);
+				++i;
+				continue;
+			}
+
+			int n = 1;
+			for (; n < len && i + n < s.size(); ++n) {
+				const unsigned char next = s[i + n];
+				if ((next & 0xC0) != 0x80) {
+					break;
+				}
+				cp = (cp << 6) | (next & 0x3F);
+			}
+			// Truncated or overlong sequence and invalid code point are replaced,
+			// decoding is continued from the first unused byte.
+			appendWide(result, (n == len && cp >= min && isValid(cp)) ? cp : REPLACEMENT);
+			i += n;
+		}
+		return result;
+	}
+
+private:
+	static constexpr char32_t REPLACEMENT = 0xFFFD;
+
+	static bool isHighSurrogate(const char32_t cp) {return cp >= 0xD800 && cp <= 0xDBFF;}
+	static bool isLowSurrogate(const char32_t cp) {return cp >= 0xDC00 && cp <= 0xDFFF;}
+	static bool isValid(const char32_t cp) {return cp <= 0x10FFFF && !(cp >= 0xD800 && cp <= 0xDFFF);}
+
+	static void appendUtf8(std::string& out, const char32_t cp)
+	{
+		if (cp < 0x80) {
+			out += static_cast<char>(cp);
+		} else if (cp < 0x800) {
+			out += static_cast<char>(0xC0 | (cp >> 6));
+			out += static_cast<char>(0x80 | (cp & 0x3F));
+		} else if (cp < 0x10000) {
+			out += static_cast<char>(0xE0 | (cp >> 12));
+			out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (cp & 0x3F));
+		} else {
+			out += static_cast<char>(0xF0 | (cp >> 18));
+			out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+			out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+	}
+
+	static void appendWide(std::wstring& out, const char32_t cp)
+	{
+		if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+			out += static_cast<wchar_t>(0xD800 + ((cp - 0x10000) >> 10));
+			out += static_cast<wchar_t>(0xDC00 + ((cp - 0x10000) & 0x3FF));
+		} else {
+			out += static_cast<wchar_t>(cp);
+		}
+	}
+};
+
 //Provides numeric and string presentation of a date and time.
 template <typename TChar = char>
 class DateTime {
@@ -360,6 +481,7 @@ struct Options {
 	static constexpr bool noLock = true;
 	static constexpr bool printTime = true;
 	static constexpr bool printDate = true;
+	static constexpr bool printContext = true;
 };
 
 // Main logger class. Implements as Meyers' singletone.
@@ -414,6 +536,159 @@ Logger<TOptions, TOutList>* Logger<TOptions, TOutList>::m_instance(nullptr);
 template <typename TOptions, typename TOutList> 
 std::mutex Logger<TOptions, TOutList>::m_createMutex;
 
+// Diagnostic context of the current thread: thread name and stack of key-value pairs.
+// It's added to each message after date and time, for example: [worker] [request=42 tenant=acme]
+// Backslash, brackets, '=' and spaces inside the name, keys and values are escaped by backslash.
+// The context is kept in UTF-8, so it's common for loggers with any character data types.
+// Its string presentation is cached for each character data type and rebuilt only after changes.
+class Context {
+public:
+	static void setThreadName(const std::string& name)
+	{
+		Data& d = data();
+		d.threadName = name;
+		++d.version;
+	}
+
+	static void setThreadName(const std::wstring& name)
+	{
+		setThreadName(Utf8<wchar_t>::encode(name));
+	}
+
+	static void push(const std::string& key, const std::string& value)
+	{
+		Data& d = data();
+		d.items.emplace_back(key, value);
+		++d.version;
+	}
+
+	static void push(const std::wstring& key, const std::wstring& value)
+	{
+		push(Utf8<wchar_t>::encode(key), Utf8<wchar_t>::encode(value));
+	}
+
+	// Removes the last pushed key-value pair.
+	static void pop()
+	{
+		Data& d = data();
+		if (!d.items.empty()) {
+			d.items.pop_back();
+			++d.version;
+		}
+	}
+
+	// Returns the number of pushed key-value pairs.
+	static size_t depth()
+	{
+		return data().items.size();
+	}
+
+	// Removes the key-value pairs pushed after the context had the depth (n).
+	static void popTo(const size_t n)
+	{
+		Data& d = data();
+		if (d.items.size() > n) {
+			d.items.resize(n);
+			++d.version;
+		}
+	}
+
+	// Returns presentation of the context (empty if there is nothing to present).
+	template <typename TChar>
+	static const std::basic_string<TChar>& prefix()
+	{
+		static thread_local Cache<TChar> cache;
+		const Data& d = data();
+		if (cache.version != d.version) {
+			cache.prefix = build<TChar>(d);
+			cache.version = d.version;
+		}
+		return cache.prefix;
+	}
+
+private:
+	struct Data {
+		std::string threadName;
+		std::vector<std::pair<std::string, std::string>> items;
+		unsigned long version = 0;
+	};
+
+	template <typename TChar>
+	struct Cache {
+		std::basic_string<TChar> prefix;
+		unsigned long version = 0;
+	};
+
+	static Data& data()
+	{
+		static thread_local Data d;
+		return d;
+	}
+
+	static std::string escape(const std::string& s)
+	{
+		std::string result;
+		result.reserve(s.size());
+		for (const char c : s) {
+			if (c == '\\' || c == '[' || c == ']' || c == '=' || c == ' ') {
+				result += '\\';
+			}
+			result += c;
+		}
+		return result;
+	}
+
+	template <typename TChar>
+	static std::basic_string<TChar> build(const Data& d)
+	{
+		constexpr auto space = str<TChar>(DefStr::space);
+		constexpr auto equal = str<TChar>(DefStr::equal);
+		constexpr auto openBr = str<TChar>(DefStr::openSqBracket);
+		constexpr auto closeBr = str<TChar>(DefStr::closeSqBracket);
+
+		std::basic_string<TChar> result;
+		if (!d.threadName.empty()) {
+			result += openBr + Utf8<TChar>::decode(escape(d.threadName)) + closeBr + space;
+		}
+		if (!d.items.empty()) {
+			result += openBr;
+			for (size_t i = 0; i < d.items.size(); ++i) {
+				if (i != 0) {
+					result += space;
+				}
+				result += Utf8<TChar>::decode(escape(d.items[i].first)) + equal +
+					Utf8<TChar>::decode(escape(d.items[i].second));
+			}
+			result += closeBr;
+			result += space;
+		}
+		return result;
+	}
+};
+
+// Pushes key-value pair to the context of the current thread. At the end of the scope
+// the context is restored to its depth before the push (pairs pushed inside the scope are removed too).
+class ScopedContext {
+public:
+	ScopedContext(const std::string& key, const std::string& value) : m_depth(Context::depth())
+	{
+		Context::push(key, value);
+	}
+
+	ScopedContext(const std::wstring& key, const std::wstring& value) : m_depth(Context::depth())
+	{
+		Context::push(key, value);
+	}
+
+	~ScopedContext() {Context::popTo(m_depth);}
+
+	ScopedContext(const ScopedContext&) = delete;
+	ScopedContext& operator=(const ScopedContext&) = delete;
+
+private:
+	size_t m_depth;
+};
+
 enum class ControlValue {
 	NL = 0, //insert new line
 	DEC, OCT, HEX //switch numeric output format
@@ -459,6 +734,9 @@ public:
 		if (TOptions::printTime) {
 			result += (openBr + dt.strTime() + closeBr + space);
 		}
+		if (TOptions::printContext) {
+			result += Context::prefix<LogChar>();
+		}
 		return result;
 	}
 
@@ -593,20 +871,31 @@ struct OptionsForStdFileSink {
 	static constexpr bool addDateTimeToFilename = true;
 };
 
+// Returns name of the log file according to the sink options (see OptionsForStdFileSink).
+template <typename TSinkOpt>
+std::string logFilename()
+{
+	DateTime<char> dt(TSinkOpt::deltaUTC);
+	return TSinkOpt::filename + 
+		(TSinkOpt::addDateTimeToFilename ? "-" + dt.strDate(true) + "-" + dt.strTime() : "");
+}
+
+// Returns mode to open the log file according to the sink options (see OptionsForStdFileSink).
+template <typename TSinkOpt>
+std::ios_base::openmode logFileMode()
+{
+	std::ios_base::openmode mode = std::ofstream::out;
+	mode |= (TSinkOpt::clearIfExist ? std::ofstream::trunc : std::ofstream::app);
+	return mode;
+}
+
 //Outputs to file
 template <typename TStr, typename TSinkOpt> 
 class StdFileSink {
 public:
 	StdFileSink()
 	{
-		DateTime<char> dt(TSinkOpt::deltaUTC);
-		std::string filename = TSinkOpt::filename + 
-			(TSinkOpt::addDateTimeToFilename ? "-" + dt.strDate(true) + "-" + dt.strTime() : "");
-
-		std::ios_base::openmode mode = std::ofstream::out;
-		mode |= (TSinkOpt::clearIfExist ? std::ofstream::trunc : std::ofstream::app);
-
-		m_ofs.open(filename, mode);
+		m_ofs.open(logFilename<TSinkOpt>(), logFileMode<TSinkOpt>());
 	}
 
 	void sink(const Level level, TStr& msg)
@@ -619,4 +908,467 @@ private:
 	OutFileStream m_ofs;
 };
 
+//Default options for SharedBackend (see below). Can be redefined by inheritance if it's necessery.
+struct OptionsForSharedBackend : public OptionsForStdFileSink {
+	static constexpr const char* filename = "./shared_log";
+	static constexpr int flushIntervalMs = 100; // period of writing batches to the file
+	static constexpr Level flushLevel = Level::ERROR; // sending of messages of this level and above waits until they are written
+};
+
+// Common backend for any number of loggers.
+// It owns the only log file and writes to it all messages from SharedSinks (see below)
+// with the same options (TBackendOpt). The loggers may have different character data types,
+// wide strings are written in UTF-8.
+// Messages are written by batches in a separate thread, in order of their sending.
+// At exit the writer thread writes the rest of messages and stops, after that messages
+// are written at once by the sending thread.
+// Implements as singleton, each options structure (TBackendOpt) gets its own instance.
+// The instance is never deleted (like DeleteMethod::DELIBERATE_MEMORY_LEAK), so loggers
+// with any delete method can use it during static destruction.
+template <typename TBackendOpt>
+class SharedBackend {
+public:
+	static SharedBackend* instance()
+	{
+		static std::once_flag flag;
+		std::call_once(flag, create);
+		return m_instance;
+	}
+
+	// Queues the message (msg is UTF-8 string) for writing.
+	// Messages of TBackendOpt::flushLevel and above are written and flushed before returning.
+	void push(const Level level, std::string msg)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_stopped) {
+			m_ofs << msg << std::endl;
+			return;
+		}
+		m_queue.push_back(std::move(msg));
+		const unsigned long seq = ++m_pushed;
+		if (level >= TBackendOpt::flushLevel) {
+			m_urgent = true;
+			m_cv.notify_one();
+			m_writtenCv.wait(lock, [this, seq](){return m_written >= seq;});
+		}
+	}
+
+private:
+	SharedBackend() : m_pushed(0), m_written(0), m_urgent(false), m_stop(false), m_stopped(false)
+	{
+		m_ofs.open(logFilename<TBackendOpt>(), logFileMode<TBackendOpt>());
+		m_thread = std::thread(&SharedBackend::run, this);
+	}
+
+	~SharedBackend(){}
+	SharedBackend(const SharedBackend&) = delete;
+	SharedBackend& operator=(const SharedBackend&) = delete;
+
+	static void create()
+	{
+		m_instance = new SharedBackend<TBackendOpt>;
+		std::atexit([](){m_instance->stop();});
+	}
+
+	// Writes the rest of messages and stops the writer thread.
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_cv.notify_one();
+		if (m_thread.joinable()) {
+			m_thread.join();
+		}
+	}
+
+	// Writer thread. Takes all queued messages at once and writes them as one batch.
+	void run()
+	{
+		const int intervalMs = TBackendOpt::flushIntervalMs;
+		const std::chrono::milliseconds interval(intervalMs);
+		std::vector<std::string> batch;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true) {
+			m_cv.wait_for(lock, interval, [this](){return m_urgent || m_stop;});
+			const bool stop = m_stop;
+			const unsigned long seq = m_pushed;
+			m_urgent = false;
+			batch.swap(m_queue);
+			lock.unlock();
+
+			write(batch);
+			batch.clear();
+
+			lock.lock();
+			m_written = seq;
+			if (stop) {
+				// Messages queued during the last batch are written here, the next ones by push().
+				write(m_queue);
+				m_queue.clear();
+				m_written = m_pushed;
+				m_stopped = true;
+			}
+			m_writtenCv.notify_all();
+			if (stop) {
+				return;
+			}
+		}
+	}
+
+	void write(const std::vector<std::string>& batch)
+	{
+		if (batch.empty()) {
+			return;
+		}
+		m_buffer.clear();
+		for (const auto& msg : batch) {
+			m_buffer += msg;
+			m_buffer += '\n';
+		}
+		m_ofs.write(m_buffer.data(), m_buffer.size());
+		m_ofs.flush();
+	}
+
+	std::ofstream m_ofs;
+	std::string m_buffer;
+	std::vector<std::string> m_queue;
+	std::mutex m_mutex;
+	std::condition_variable m_cv; // wakes the writer thread
+	std::condition_variable m_writtenCv; // notifies about written batches
+	unsigned long m_pushed; // number of queued messages
+	unsigned long m_written; // number of written messages
+	bool m_urgent;
+	bool m_stop;
+	bool m_stopped;
+	std::thread m_thread;
+
+	static SharedBackend* m_instance;
+};
+
+template <typename TBackendOpt>
+SharedBackend<TBackendOpt>* SharedBackend<TBackendOpt>::m_instance(nullptr);
+
+//Outputs to the shared backend. Options of the sink (TBackendOpt) select the backend.
+template <typename TStr, typename TBackendOpt>
+class SharedSink {
+public:
+	using Backend = SharedBackend<TBackendOpt>;
+
+	SharedSink() : m_backend(Backend::instance()) {}
+
+	void sink(const Level level, TStr& msg)
+	{
+		m_backend->push(level, Utf8<typename TStr::value_type>::encode(msg));
+	}
+
+private:
+	Backend* m_backend;
+};
+
+//Default options for FlightRecorder (see below). Can be redefined by inheritance if it's necessery.
+struct OptionsForFlightRecorder {
+	static constexpr DeleteMethod deleteMethod = DeleteMethod::AT_EXIT;
+	static constexpr int capacity = 256; // number of the last messages kept for each thread
+	static constexpr Level dumpLevel = Level::ERROR; // messages of this level and above cause the dump
+	static constexpr bool dumpAllThreads = false; // dump messages of all threads or of the current one only
+
+	// Sink to dump the kept messages to and its options.
+	// The recorder creates its own instance of the sink. To dump to the same file as other outs
+	// of the logger use SharedSink with the same backend options for all of them. A sink which
+	// owns the file (for example, StdFileSink) must not share its options with other outs.
+	template <typename TStr, typename TSinkOpt>
+	using DumpSink = SharedSink<TStr, TSinkOpt>;
+	using DumpSinkOptions = OptionsForSharedBackend;
+};
+
+// Keeps the last messages of each thread in memory (circular buffer with fixed size)
+// without any output. The messages are dumped to the real sink (TRecorderOpt::DumpSink)
+// when a message of TRecorderOpt::dumpLevel or above arrives, when dump()/dumpAll()
+// is called, or on std::terminate if installTerminateHandler() was called.
+// Dumped messages are removed from the buffers, the buffer of a finished thread is dropped.
+// Implements as singleton, each pair of string type (TStr) and options structure (TRecorderOpt)
+// gets its own instance.
+template <typename TStr, typename TRecorderOpt>
+class FlightRecorder {
+	static_assert(TRecorderOpt::capacity > 0, "Capacity of the flight recorder must be positive.");
+
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static FlightRecorder* instance()
+	{
+		static std::once_flag flag;
+		std::call_once(flag, create);
+		return m_instance;
+	}
+
+	// Keeps the message in the buffer of the current thread and dumps if it's necessery.
+	void record(const Level level, const TStr& msg)
+	{
+		threadRing().put(level, Clock::now(), msg);
+		if (level >= TRecorderOpt::dumpLevel) {
+			if (TRecorderOpt::dumpAllThreads) {
+				dumpAll();
+			} else {
+				dump();
+			}
+		}
+	}
+
+	// Dumps the messages of the current thread.
+	void dump()
+	{
+		Records records;
+		threadRing().take(records);
+		if (!records.empty()) {
+			write(records, records.back().level);
+		}
+	}
+
+	// Dumps the messages of all threads ordered by time.
+	void dumpAll()
+	{
+		Records records;
+		{
+			std::lock_guard<std::mutex> lock(m_ringsMutex);
+			for (auto ring : m_rings) {
+				ring->take(records);
+			}
+		}
+		std::stable_sort(records.begin(), records.end(),
+			[](const Record& a, const Record& b){return a.timestamp < b.timestamp;});
+		if (!records.empty()) {
+			write(records, records.back().level);
+		}
+	}
+
+	// Makes std::terminate dump the messages of all threads before calling the previous handler.
+	// The dump skips buffers being changed at the moment instead of waiting for them.
+	// Repeated calls do nothing. The handler is removed when the recorder is deleted.
+	static void installTerminateHandler()
+	{
+		instance();
+		static std::once_flag flag;
+		std::call_once(flag, [](){m_prevTerminate = std::set_terminate(onTerminate);});
+	}
+
+private:
+	struct Record {
+		Level level;
+		Clock::time_point timestamp;
+		TStr msg;
+	};
+	using Records = std::vector<Record>;
+
+	// Circular buffer of one thread.
+	// Only the owner thread puts messages, so the spin lock is contended during dumps only.
+	class Ring {
+	public:
+		Ring() : m_records(TRecorderOpt::capacity), m_next(0), m_size(0)
+		{
+			m_busy.clear();
+		}
+
+		void put(const Level level, const Clock::time_point timestamp, const TStr& msg)
+		{
+			SpinLock lock(m_busy);
+			Record& record = m_records[m_next];
+			record.level = level;
+			record.timestamp = timestamp;
+			record.msg.assign(msg); // reuses memory of the overwritten message
+			m_next = (m_next + 1) % m_records.size();
+			if (m_size < m_records.size()) {
+				++m_size;
+			}
+		}
+
+		// Appends the kept messages (from the oldest to the newest) to out and clears the buffer.
+		// If wait = false and the buffer is busy, does nothing and returns false.
+		bool take(Records& out, const bool wait = true)
+		{
+			SpinLock lock(m_busy, wait);
+			if (!lock.owns) {
+				return false;
+			}
+			const size_t capacity = m_records.size();
+			const size_t first = (m_next + capacity - m_size) % capacity;
+			for (size_t i = 0; i < m_size; ++i) {
+				out.push_back(m_records[(first + i) % capacity]);
+			}
+			m_size = 0;
+			return true;
+		}
+
+	private:
+		struct SpinLock {
+			SpinLock(std::atomic_flag& flag, const bool wait = true) : m_flag(flag), owns(true)
+			{
+				while (m_flag.test_and_set(std::memory_order_acquire)) {
+					if (!wait) {
+						owns = false;
+						return;
+					}
+					std::this_thread::yield();
+				}
+			}
+			~SpinLock()
+			{
+				if (owns) {
+					m_flag.clear(std::memory_order_release);
+				}
+			}
+			std::atomic_flag& m_flag;
+			bool owns;
+		};
+
+		Records m_records;
+		size_t m_next;
+		size_t m_size;
+		std::atomic_flag m_busy;
+	};
+
+	// Owns the buffer of a thread. Registers it in the recorder and unregisters at the thread exit.
+	class RingHolder {
+	public:
+		RingHolder(FlightRecorder* recorder) : m_recorder(recorder), m_ring(new Ring)
+		{
+			std::lock_guard<std::mutex> lock(m_recorder->m_ringsMutex);
+			m_recorder->m_rings.push_back(m_ring.get());
+		}
+
+		~RingHolder()
+		{
+			std::lock_guard<std::mutex> lock(m_recorder->m_ringsMutex);
+			auto& rings = m_recorder->m_rings;
+			rings.erase(std::remove(rings.begin(), rings.end(), m_ring.get()), rings.end());
+		}
+
+		Ring& ring() {return *m_ring;}
+
+	private:
+		FlightRecorder* m_recorder;
+		std::unique_ptr<Ring> m_ring;
+	};
+
+	FlightRecorder(){}
+	~FlightRecorder(){}
+	FlightRecorder(const FlightRecorder&) = delete;
+	FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+	static void create()
+	{
+		m_instance = new FlightRecorder<TStr, TRecorderOpt>;
+		if (TRecorderOpt::deleteMethod == DeleteMethod::AT_EXIT) {
+			std::atexit(destroy);
+		}
+	}
+
+	// Uninstalls the terminate handler (unless other one was installed over it) and deletes the recorder.
+	// If the handler stays in a chain of handlers, it skips the dump after that.
+	static void destroy()
+	{
+		if (std::get_terminate() == onTerminate) {
+			std::set_terminate(m_prevTerminate);
+		}
+		FlightRecorder* recorder = m_instance;
+		m_instance = nullptr;
+		delete recorder;
+	}
+
+	static void onTerminate()
+	{
+		if (m_instance) {
+			m_instance->crashDump();
+		}
+		if (m_prevTerminate) {
+			m_prevTerminate();
+		}
+		std::abort();
+	}
+
+	Ring& threadRing()
+	{
+		static thread_local RingHolder holder(this);
+		return holder.ring();
+	}
+
+	// Dumps the messages of all threads without waiting for any lock.
+	void crashDump()
+	{
+		Records records;
+		std::unique_lock<std::mutex> lock(m_ringsMutex, std::try_to_lock);
+		if (!lock.owns_lock()) {
+			return;
+		}
+		for (auto ring : m_rings) {
+			ring->take(records, false);
+		}
+		lock.unlock();
+		std::stable_sort(records.begin(), records.end(),
+			[](const Record& a, const Record& b){return a.timestamp < b.timestamp;});
+		if (!records.empty()) {
+			write(records, Level::FATAL, false);
+		}
+	}
+
+	// Outputs the records to the dump sink between header and footer lines.
+	// The header and footer are sent with the level (FATAL on crash makes a shared backend flush them).
+	// If wait = false and other dump is in progress, does nothing.
+	void write(Records& records, const Level level, const bool wait = true)
+	{
+		using TChar = typename TStr::value_type;
+		constexpr auto space = str<TChar>(DefStr::space);
+		constexpr auto lrArrow = str<TChar>(DefStr::lrArrow);
+		constexpr auto rlArrow = str<TChar>(DefStr::rlArrow);
+		constexpr auto name = str<TChar>(DefStr::flightRecorder);
+		TStr header = lrArrow + (space + TStr(name));
+		TStr footer = rlArrow + (space + TStr(name));
+
+		std::unique_lock<std::mutex> lock(m_dumpMutex, std::defer_lock);
+		if (wait) {
+			lock.lock();
+		} else if (!lock.try_lock()) {
+			return;
+		}
+		m_sink.sink(level, header);
+		for (auto& record : records) {
+			m_sink.sink(record.level, record.msg);
+		}
+		m_sink.sink(level, footer);
+	}
+
+	std::vector<Ring*> m_rings;
+	std::mutex m_ringsMutex;
+	typename TRecorderOpt::template DumpSink<TStr, typename TRecorderOpt::DumpSinkOptions> m_sink;
+	std::mutex m_dumpMutex;
+
+	static FlightRecorder* m_instance;
+	static std::terminate_handler m_prevTerminate;
+};
+
+template <typename TStr, typename TRecorderOpt>
+FlightRecorder<TStr, TRecorderOpt>* FlightRecorder<TStr, TRecorderOpt>::m_instance(nullptr);
+
+template <typename TStr, typename TRecorderOpt>
+std::terminate_handler FlightRecorder<TStr, TRecorderOpt>::m_prevTerminate(nullptr);
+
+//Outputs to the flight recorder. Options of the sink (TRecorderOpt) select the recorder.
+template <typename TStr, typename TRecorderOpt>
+class FlightRecorderSink {
+public:
+	using Recorder = FlightRecorder<TStr, TRecorderOpt>;
+
+	FlightRecorderSink() : m_recorder(Recorder::instance()) {}
+
+	void sink(const Level level, TStr& msg)
+	{
+		m_recorder->record(level, msg);
+	}
+
+private:
+	Recorder* m_recorder;
+};
+
 };
@@ -9,10 +9,23 @@ int main ()
 	std::string s = "Test msg";
 	std::wstring ws = L"Test msg";
 
+	FlightLogger::Recorder::installTerminateHandler();
+
 	MLOG::trace() << "MLOG " << s << MLOG::CV::HEX << 777 << " " << MLOG::CV::DEC <<= 888;
 	ALOG::trace() << "ALOG " << s << ALOG::CV::HEX << 777 << " " << ALOG::CV::DEC <<= 888;
 	WLOG::trace() << L"WLOG " << ws << WLOG::CV::HEX << 777 << L" " << WLOG::CV::DEC <<= 888;
 	WLOG::debug() << L"WLOG " << ws << WLOG::CV::HEX << 777 << L" " << WLOG::CV::DEC <<= 888;
+	SLOG::info() << "SLOG " << s << SLOG::CV::HEX << 777 << " " << SLOG::CV::DEC <<= 888;
+	SWLOG::info() << L"SWLOG " << ws << SWLOG::CV::HEX << 777 << L" " << SWLOG::CV::DEC <<= 888;
+	FLOG::trace() << "FLOG " << s << FLOG::CV::HEX << 777 << " " << FLOG::CV::DEC <<= 888;
+	Logger::Context::setThreadName("main");
+	{
+		Logger::ScopedContext request("request", "42");
+		Logger::ScopedContext tenant(L"tenant", L"acme");
+		ALOG::info() << "ALOG " << s << ALOG::CV::HEX << 777 << " " << ALOG::CV::DEC <<= 888;
+		WLOG::info() << L"WLOG " << ws << WLOG::CV::HEX << 777 << L" " << WLOG::CV::DEC <<= 888;
+	}
+	FLOG::error() << "FLOG " << s << FLOG::CV::HEX << 777 << " " << FLOG::CV::DEC <<= 888;
 
 	return 0;
 }
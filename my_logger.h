@@ -79,3 +79,65 @@ namespace WCharLogger {
 	typedef Logger::NumMarkedList<2, Item>::T OutList;
 }
 using WLOG = Logger::LogEntry<WCharLogger::Options, WCharLogger::OutList>;
+
+// Loggers with shared backend.
+// Character data types - char and wchar_t; number of outs - 1.
+// Both loggers write to the same file through one backend, so their messages are ordered by time.
+namespace SharedLogger {
+
+	struct Options : public Logger::Options {
+		static constexpr int deltaUTC = 3;
+	};
+
+	struct WOptions : public Options {
+		using LogChar = wchar_t;
+	};
+
+	struct BackendOptions : public Logger::OptionsForSharedBackend {
+		static constexpr int deltaUTC = 3;
+		static constexpr const char* filename = "./myapp_shared_log";
+	};
+
+	template <int N> struct Item {};
+	template <> struct Item<1> {
+		typedef Logger::Out<Options::LogChar, Logger::AnyFilter, Logger::NullType, Logger::SharedSink, BackendOptions> TData;
+	};
+	typedef Logger::NumMarkedList<1, Item>::T OutList;
+
+	template <int N> struct WItem {};
+	template <> struct WItem<1> {
+		typedef Logger::Out<WOptions::LogChar, Logger::AnyFilter, Logger::NullType, Logger::SharedSink, BackendOptions> TData;
+	};
+	typedef Logger::NumMarkedList<1, WItem>::T WOutList;
+}
+using SLOG = Logger::LogEntry<SharedLogger::Options, SharedLogger::OutList>;
+using SWLOG = Logger::LogEntry<SharedLogger::WOptions, SharedLogger::WOutList>;
+
+// Logger with flight recorder.
+// Character data type - char; number of outs - 2.
+// All messages are kept in memory and dumped to the shared file of SLOG/SWLOG only when
+// a message of ERROR level or above arrives. Messages of TRACE level aren't output to std::cout.
+namespace FlightLogger {
+
+	struct Options : public Logger::Options {
+		static constexpr int deltaUTC = 3;
+	};
+
+	struct RecorderOptions : public Logger::OptionsForFlightRecorder {
+		static constexpr int capacity = 64;
+		using DumpSinkOptions = SharedLogger::BackendOptions;
+	};
+
+	template <int N> struct Item {};
+	template <> struct Item<1> {
+		typedef Logger::Out<Options::LogChar, Logger::AnyFilter, Logger::NullType, Logger::FlightRecorderSink, RecorderOptions> TData;
+	};
+	template <> struct Item<2> {
+		typedef Logger::Out<Options::LogChar, Logger::TraceFilter, Logger::NullType, Logger::CoutSink, Logger::NullType> TData;
+	};
+	typedef Logger::NumMarkedList<2, Item>::T OutList;
+
+	// Gives access to dump()/dumpAll()/installTerminateHandler().
+	using Recorder = Logger::FlightRecorder<std::basic_string<Options::LogChar>, RecorderOptions>;
+}
+using FLOG = Logger::LogEntry<FlightLogger::Options, FlightLogger::OutList>;